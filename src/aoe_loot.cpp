@@ -16,14 +16,41 @@
 #include "Map.h"
 #include <fmt/format.h>
 #include "Corpse.h"
+#include "Bag.h"
+#include "LootItemStorage.h"
+#include "Mail.h"
+#include "DatabaseEnv.h"
+#include "GameObject.h"
+#include "GridNotifiers.h"
+#include "GridNotifiersImpl.h"
+#include "CellImpl.h"
+#include "DBCStores.h"
+#include "Spell.h"
+#include "SpellInfo.h"
 #include "Group.h"
 #include "ObjectMgr.h"
+#include "StringConvert.h"
+#include "Tokenize.h"
+#include <algorithm>
+#include <set>
 
 using namespace Acore::ChatCommands;
 using namespace WorldPackets;
 
 std::map<uint64, bool> AoeLootCommandScript::playerAoeLootEnabled;
 std::map<uint64, bool> AoeLootCommandScript::playerAoeLootDebug;
+std::map<uint64, uint8> AoeLootCommandScript::playerAoeLootQuality;
+std::map<uint64, AoeLootPlayerFilter> AoeLootCommandScript::playerAoeLootFilters;
+std::vector<uint8> AoeLootCommandScript::itemFilterTable;
+
+// >>>>> Item filter table entry layout. <<<<< //
+
+enum AoeLootItemFilter : uint8
+{
+    AOELOOT_FILTER_QUALITY_MASK = 0x07,
+    AOELOOT_FILTER_ALLOW        = 0x40,
+    AOELOOT_FILTER_DENY         = 0x80
+};
 
 
 // Server packet handler. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
@@ -32,35 +59,36 @@ std::map<uint64, bool> AoeLootCommandScript::playerAoeLootDebug;
 
 bool AoeLootManager::CanPacketReceive(WorldSession* session, WorldPacket& packet)
 {
+    Player* player = session->GetPlayer();
+    if (!player)
+        return true;
+
     if (packet.GetOpcode() == CMSG_LOOT)
     {
-        Player* player = session->GetPlayer();
-        if (player)
-        {
-            uint64 guid = player->GetGUID().GetRawValue();
-
-            // >>>>> Do not remove the hardcoded value. It is here for crash & data protection. <<<<< //
+        // >>>>> Aoe looting enabled check. <<<<< //
 
-            if (!AoeLootCommandScript::hasPlayerAoeLootEnabled(guid))
-            {
-                AoeLootCommandScript::SetPlayerAoeLootEnabled(guid, sConfigMgr->GetOption<bool>("AOELoot.Enable", true));
-            }
-            if (!AoeLootCommandScript::hasPlayerAoeLootDebug(guid)) 
-            {
-                AoeLootCommandScript::SetPlayerAoeLootDebug(guid, sConfigMgr->GetOption<bool>("AOELoot.Debug", false));
-            }
+        if (AoeLootCommandScript::IsPlayerAoeLootActive(player))
+        {
 
-            // >>>>> Aoe looting enabled check. <<<<< //
+            // >>>>> Aoe loot start. <<<<< //
 
-            if (AoeLootCommandScript::hasPlayerAoeLootEnabled(guid) && AoeLootCommandScript::GetPlayerAoeLootEnabled(guid))
-            {
+            AoeLootCommandScript::DebugMessage(player, "AOE Looting started.");
+            ChatHandler handler(player->GetSession());
+            handler.ParseCommands(".aoeloot startaoeloot");
+        }
+    }
+    else if (packet.GetOpcode() == CMSG_GAMEOBJ_USE && packet.size() >= sizeof(uint64) &&
+        sConfigMgr->GetOption<bool>("AOELoot.GameObjects", false) && player->IsInWorld())
+    {
 
-                // >>>>> Aoe loot start. <<<<< //
+        // >>>>> Using an unlocked chest starts the sweep too. The used chest itself is left to the core. <<<<< //
 
-                AoeLootCommandScript::DebugMessage(player, "AOE Looting started.");
-                ChatHandler handler(player->GetSession());
-                handler.ParseCommands(".aoeloot startaoeloot");
-            }
+        ObjectGuid goGuid(packet.read<uint64>(0));
+        GameObject* go = player->GetMap()->GetGameObject(goGuid);
+        if (go && go->GetGoType() == GAMEOBJECT_TYPE_CHEST && AoeLootCommandScript::IsPlayerAoeLootActive(player))
+        {
+            AoeLootCommandScript::DebugMessage(player, "AOE Looting started.");
+            AoeLootCommandScript::StartAoeLoot(player, goGuid);
         }
     }
     return true;
@@ -69,6 +97,24 @@ bool AoeLootManager::CanPacketReceive(WorldSession* session, WorldPacket& packet
 // Server packet handler end. <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< //
 
 
+// World script hooks. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
+// >>>>> Item templates are not loaded yet on the first config load, OnStartup covers that case. <<<<< //
+
+void AoeLootWorld::OnAfterConfigLoad(bool reload)
+{
+    if (reload)
+        AoeLootCommandScript::LoadItemFilterTable();
+}
+
+void AoeLootWorld::OnStartup()
+{
+    AoeLootCommandScript::LoadItemFilterTable();
+}
+
+// World script hooks end. <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< //
+
+
 // Command table implementation. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
 
 ChatCommandTable AoeLootCommandScript::GetCommands() const
@@ -81,7 +127,14 @@ ChatCommandTable AoeLootCommandScript::GetCommands() const
         { "off",            HandleAoeLootOffCommand,            SEC_PLAYER, Console::No },
         { "debug on",       HandleAoeLootDebugOnCommand,        SEC_PLAYER, Console::No },
         { "debug",          HandleAoeLootDebugToggleCommand,    SEC_PLAYER, Console::No },
-        { "debug off",      HandleAoeLootDebugOffCommand,       SEC_PLAYER, Console::No }
+        { "debug off",      HandleAoeLootDebugOffCommand,       SEC_PLAYER, Console::No },
+        { "quality",        HandleAoeLootQualityCommand,        SEC_PLAYER, Console::No },
+        { "filter item",    HandleAoeLootFilterItemCommand,     SEC_PLAYER, Console::No },
+        { "filter class",   HandleAoeLootFilterClassCommand,    SEC_PLAYER, Console::No },
+        { "filter clear",   HandleAoeLootFilterClearCommand,    SEC_PLAYER, Console::No },
+        { "open",           HandleAoeLootOpenCommand,           SEC_PLAYER, Console::No },
+        { "skin",           HandleAoeLootSkinCommand,           SEC_PLAYER, Console::No },
+        { "group",          HandleAoeLootGroupCommand,          SEC_PLAYER, Console::No }
     };
 
     static ChatCommandTable aoeLootCommandTable =
@@ -179,6 +232,58 @@ bool AoeLootCommandScript::hasPlayerAoeLootDebug(uint64 guid)
     return playerAoeLootDebug.count(guid) > 0;
 }
 
+uint8 AoeLootCommandScript::GetPlayerAoeLootQuality(uint64 guid)
+{
+    auto it = playerAoeLootQuality.find(guid);
+    if (it != playerAoeLootQuality.end())
+        return it->second;
+    return 0;
+}
+
+void AoeLootCommandScript::SetPlayerAoeLootQuality(uint64 guid, uint8 quality)
+{
+    playerAoeLootQuality[guid] = quality;
+    AoeLootCommandScript::DebugMessage(nullptr, fmt::format("Set AOE loot minimum quality for GUID {}: {}", guid, quality));
+}
+
+void AoeLootCommandScript::RemovePlayerLootQuality(uint64 guid)
+{
+    if (playerAoeLootQuality.erase(guid) > 0)
+        AoeLootCommandScript::DebugMessage(nullptr, fmt::format("Removed AOE loot minimum quality for GUID {}", guid));
+}
+
+AoeLootPlayerFilter const* AoeLootCommandScript::GetPlayerAoeLootFilter(uint64 guid)
+{
+    auto it = playerAoeLootFilters.find(guid);
+    if (it != playerAoeLootFilters.end() && !it->second.empty())
+        return &it->second;
+    return nullptr;
+}
+
+void AoeLootCommandScript::RemovePlayerLootFilter(uint64 guid)
+{
+    if (playerAoeLootFilters.erase(guid) > 0)
+        AoeLootCommandScript::DebugMessage(nullptr, fmt::format("Removed AOE loot filter for GUID {}", guid));
+}
+
+bool AoeLootCommandScript::IsPlayerAoeLootActive(Player* player)
+{
+    uint64 guid = player->GetGUID().GetRawValue();
+
+    // >>>>> Do not remove the hardcoded value. It is here for crash & data protection. <<<<< //
+
+    if (!AoeLootCommandScript::hasPlayerAoeLootEnabled(guid))
+    {
+        AoeLootCommandScript::SetPlayerAoeLootEnabled(guid, sConfigMgr->GetOption<bool>("AOELoot.Enable", true));
+    }
+    if (!AoeLootCommandScript::hasPlayerAoeLootDebug(guid)) 
+    {
+        AoeLootCommandScript::SetPlayerAoeLootDebug(guid, sConfigMgr->GetOption<bool>("AOELoot.Debug", false));
+    }
+
+    return AoeLootCommandScript::hasPlayerAoeLootEnabled(guid) && AoeLootCommandScript::GetPlayerAoeLootEnabled(guid);
+}
+
 // Getters and setters end. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
 
 
@@ -350,6 +455,237 @@ bool AoeLootCommandScript::HandleAoeLootDebugToggleCommand(ChatHandler* handler,
     return true;
 }
 
+bool AoeLootCommandScript::HandleAoeLootQualityCommand(ChatHandler* handler, Optional<uint8> quality)
+{
+    Player* player = handler->GetSession()->GetPlayer();
+    if (!player)
+        return true;
+
+    if (!sConfigMgr->GetOption<bool>("AOELoot.Filter.Enable", false))
+    {
+        handler->PSendSysMessage("AOE Loot filtering is disabled on this server.");
+        return true;
+    }
+
+    uint64 playerGuid = player->GetGUID().GetRawValue();
+    if (!quality)
+    {
+        handler->PSendSysMessage("AOE Loot minimum item quality for your character: {}. Type: '.aoeloot quality <0-7>' to change it.", GetPlayerAoeLootQuality(playerGuid));
+        return true;
+    }
+
+    if (*quality >= MAX_ITEM_QUALITY)
+    {
+        handler->PSendSysMessage("Invalid item quality. Use a value from 0 (Poor) to {}.", MAX_ITEM_QUALITY - 1);
+        return true;
+    }
+
+    AoeLootCommandScript::SetPlayerAoeLootQuality(playerGuid, *quality);
+    handler->PSendSysMessage("AOE Loot will now skip items below quality {} for your character.", *quality);
+    DebugMessage(player, fmt::format("Minimum item quality set to {}.", *quality));
+
+    return true;
+}
+
+bool AoeLootCommandScript::HandleAoeLootFilterItemCommand(ChatHandler* handler, uint32 itemId)
+{
+    Player* player = handler->GetSession()->GetPlayer();
+    if (!player)
+        return true;
+
+    if (!sConfigMgr->GetOption<bool>("AOELoot.Filter.Enable", false))
+    {
+        handler->PSendSysMessage("AOE Loot filtering is disabled on this server.");
+        return true;
+    }
+
+    if (!sObjectMgr->GetItemTemplate(itemId))
+    {
+        handler->PSendSysMessage("Item {} does not exist.", itemId);
+        return true;
+    }
+
+    // >>>>> The same command adds and removes an item from the player's deny list. <<<<< //
+
+    AoeLootPlayerFilter& filter = playerAoeLootFilters[player->GetGUID().GetRawValue()];
+    if (filter.denyItems.erase(itemId) > 0)
+    {
+        handler->PSendSysMessage("AOE Loot will loot item {} again.", itemId);
+        return true;
+    }
+
+    filter.denyItems.insert(itemId);
+    handler->PSendSysMessage("AOE Loot will now skip item {} for your character.", itemId);
+    return true;
+}
+
+bool AoeLootCommandScript::HandleAoeLootFilterClassCommand(ChatHandler* handler, uint32 itemClass, Optional<uint32> itemSubClass)
+{
+    Player* player = handler->GetSession()->GetPlayer();
+    if (!player)
+        return true;
+
+    if (!sConfigMgr->GetOption<bool>("AOELoot.Filter.Enable", false))
+    {
+        handler->PSendSysMessage("AOE Loot filtering is disabled on this server.");
+        return true;
+    }
+
+    if (itemClass >= MAX_ITEM_CLASS)
+    {
+        handler->PSendSysMessage("Invalid item class. Use a value from 0 to {}.", MAX_ITEM_CLASS - 1);
+        return true;
+    }
+
+    // >>>>> "class" blocks the whole class, "class subclass" only one subclass. Repeating a rule removes it. <<<<< //
+
+    AoeLootPlayerFilter& filter = playerAoeLootFilters[player->GetGUID().GetRawValue()];
+    std::set<uint32>& rules = itemSubClass ? filter.denySubClasses : filter.denyClasses;
+    uint32 key = itemSubClass ? ((itemClass << 8) | *itemSubClass) : itemClass;
+    std::string ruleName = itemSubClass ? fmt::format("{}:{}", itemClass, *itemSubClass) : fmt::format("{}", itemClass);
+
+    if (rules.erase(key) > 0)
+    {
+        handler->PSendSysMessage("AOE Loot will loot item class {} again.", ruleName);
+        return true;
+    }
+
+    rules.insert(key);
+    handler->PSendSysMessage("AOE Loot will now skip item class {} for your character.", ruleName);
+    return true;
+}
+
+bool AoeLootCommandScript::HandleAoeLootFilterClearCommand(ChatHandler* handler, Optional<std::string> /*args*/)
+{
+    Player* player = handler->GetSession()->GetPlayer();
+    if (!player)
+        return true;
+
+    RemovePlayerLootFilter(player->GetGUID().GetRawValue());
+    handler->PSendSysMessage("AOE Loot item and class filters cleared for your character.");
+    return true;
+}
+
+bool AoeLootCommandScript::HandleAoeLootOpenCommand(ChatHandler* handler, Optional<std::string> /*args*/)
+{
+    if (!sConfigMgr->GetOption<bool>("AOELoot.Enable", true) ||
+        !sConfigMgr->GetOption<bool>("AOELoot.OpenContainers", true))
+    {
+        handler->PSendSysMessage("AOE Loot container opening is disabled on this server.");
+        return true;
+    }
+
+    Player* player = handler->GetSession()->GetPlayer();
+    if (!player)
+        return true;
+
+    std::vector<Item*> containers = GetLootableContainers(player);
+    if (containers.empty())
+    {
+        handler->PSendSysMessage("AOE Loot found no lootable containers in your bags.");
+        return true;
+    }
+
+    AoeLootSweep sweep;
+    uint32 openedCount = 0;
+    for (Item* item : containers)
+    {
+        if (ProcessContainerLoot(player, item, sweep))
+            ++openedCount;
+    }
+
+    // >>>>> One summary for the whole pass instead of a loot window per container. <<<<< //
+
+    handler->PSendSysMessage("AOE Loot opened {} of {} containers: looted {} items and {} copper.", openedCount, containers.size(), sweep.lootedItemCount, sweep.lootedMoney);
+    return true;
+}
+
+bool AoeLootCommandScript::HandleAoeLootSkinCommand(ChatHandler* handler, Optional<std::string> /*args*/)
+{
+    if (!sConfigMgr->GetOption<bool>("AOELoot.Enable", true) ||
+        !sConfigMgr->GetOption<bool>("AOELoot.Skinning", false))
+    {
+        handler->PSendSysMessage("AOE Loot skinning is disabled on this server.");
+        return true;
+    }
+
+    Player* player = handler->GetSession()->GetPlayer();
+    if (!player)
+        return true;
+
+    AoeLootSweep sweep;
+    sweep.overflowMail = sConfigMgr->GetOption<bool>("AOELoot.OverflowMail", false);
+
+    ProcessSkinningSweep(player, sConfigMgr->GetOption<float>("AOELoot.Range", 55.0f), sweep);
+    ApplySkillUps(player, sweep.skillUps);
+    SendOverflowMail(player, sweep.overflowItems);
+
+    handler->PSendSysMessage("AOE Loot gathered {} corpses: looted {} items.", sweep.skillUps.size(), sweep.lootedItemCount);
+    return true;
+}
+
+bool AoeLootCommandScript::HandleAoeLootGroupCommand(ChatHandler* handler, Optional<std::string> /*args*/)
+{
+    if (!sConfigMgr->GetOption<bool>("AOELoot.Enable", true) ||
+        !sConfigMgr->GetOption<bool>("AOELoot.GroupSweep", false))
+    {
+        handler->PSendSysMessage("AOE Loot group sweep is disabled on this server.");
+        return true;
+    }
+
+    Player* player = handler->GetSession()->GetPlayer();
+    if (!player)
+        return true;
+
+    Group* group = player->GetGroup();
+    if (!group)
+    {
+        handler->PSendSysMessage("AOE Loot group sweep requires a group.");
+        return true;
+    }
+
+    LootMethod lootMethod = group->GetLootMethod();
+    if (lootMethod != MASTER_LOOT && lootMethod != FREE_FOR_ALL)
+    {
+        handler->PSendSysMessage("AOE Loot group sweep only works with Master Loot or Free for All.");
+        return true;
+    }
+
+    // >>>>> Master loot: the master looter triggers the sweep. Free for all: the group leader does. <<<<< //
+
+    ObjectGuid triggerGuid = lootMethod == MASTER_LOOT ? group->GetMasterLooterGuid() : group->GetLeaderGUID();
+    if (player->GetGUID() != triggerGuid)
+    {
+        handler->PSendSysMessage("Only the {} can start an AOE Loot group sweep.", lootMethod == MASTER_LOOT ? "master looter" : "group leader");
+        return true;
+    }
+
+    float range = sConfigMgr->GetOption<float>("AOELoot.Range", 55.0f);
+    auto validCorpses = GetGroupCorpses(player, group, range);
+    if (validCorpses.empty())
+    {
+        handler->PSendSysMessage("AOE Loot found no corpses to loot for your group.");
+        return true;
+    }
+
+    // >>>>> One scan and one Loot traversal per corpse for the whole group. <<<<< //
+
+    AoeLootSweep sweep;
+    sweep.moneyShareMembers = GetMoneyShareMembers(player);
+    if (sweep.moneyShareMembers.empty())
+        sweep.moneyShareMembers.push_back(player);
+
+    for (auto* creature : validCorpses)
+    {
+        ProcessGroupCreatureLoot(player, creature, sweep);
+    }
+
+    ProcessLootRelease(player, sweep.releasedCorpses);
+
+    handler->PSendSysMessage("AOE Loot group sweep looted {} of {} corpses for {} group members.", sweep.releasedCorpses.size(), validCorpses.size(), sweep.moneyShareMembers.size());
+    return true;
+}
+
 // Command handlers implementation End. <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< //
 
 
@@ -389,6 +725,33 @@ std::vector<Player*> AoeLootCommandScript::GetGroupMembers(Player* player)
     return members;
 }
 
+std::vector<Player*> AoeLootCommandScript::GetMoneyShareMembers(Player* player)
+{
+    std::vector<Player*> eligibleMembers;
+    if (!player->GetGroup() || !sConfigMgr->GetOption<bool>("AOELoot.Group", true))
+        return eligibleMembers;
+
+    // >>>>> For AoE loot, we allow money sharing within a larger range. <<<<< //
+
+    float range = sConfigMgr->GetOption<float>("AOELoot.Range", 55.0f);
+    float moneyShareMultiplier = sConfigMgr->GetOption<float>("AOELoot.MoneyShareDistanceMultiplier", 2.0f);
+    float moneyRange = range * moneyShareMultiplier;
+
+    for (Player* member : GetGroupMembers(player))
+    {
+        // >>>>> Check if the member is eligible for money sharing <<<<< //
+
+        if (member->IsWithinDistInMap(player, moneyRange) || 
+            member->IsAtLootRewardDistance(player))
+        {
+            eligibleMembers.push_back(member);
+        }
+    }
+
+    DebugMessage(player, fmt::format("Found {} group members eligible for money sharing", eligibleMembers.size()));
+    return eligibleMembers;
+}
+
 bool AoeLootCommandScript::IsValidLootTarget(Player* player, Creature* creature)
 {
     if (!creature || !player)
@@ -403,6 +766,14 @@ bool AoeLootCommandScript::IsValidLootTarget(Player* player, Creature* creature)
     if (!creature->HasDynamicFlag(UNIT_DYNFLAG_LOOTABLE))
         return false;
 
+    // >>>>> Loot rights: tap owner, recipient group, round robin rules and whether anything is left for this player. <<<<< //
+
+    if (!player->isAllowedToLoot(creature))
+    {
+        DebugMessage(player, fmt::format("Not allowed to loot {}", creature->GetName()));
+        return false;
+    }
+
     uint64 playerGuid = player->GetGUID().GetRawValue();
     if (!AoeLootCommandScript::hasPlayerAoeLootEnabled(playerGuid))
     {
@@ -420,46 +791,321 @@ bool AoeLootCommandScript::IsValidLootTarget(Player* player, Creature* creature)
     return true;
 }
 
-void AoeLootCommandScript::ProcessQuestItems(Player* player, ObjectGuid lguid, Loot* loot)
+void AoeLootCommandScript::LoadItemFilterTable()
 {
-    if (!player || !loot)
+    itemFilterTable.clear();
+
+    if (!sConfigMgr->GetOption<bool>("AOELoot.Filter.Enable", false))
         return;
-        
-    // >>>>> Process different quest item types. <<<<< //
 
-    const QuestItemMap& questItems = loot->GetPlayerQuestItems();
-    for (uint8 i = 0; i < questItems.size(); ++i)
+    ItemTemplateContainer const* itemTemplates = sObjectMgr->GetItemTemplateStore();
+    if (!itemTemplates || itemTemplates->empty())
+        return;
+
+    // >>>>> Config lists are comma separated, class rules are either "class" or "class:subclass". <<<<< //
+
+    auto parseIdList = [](std::string const& option)
+    {
+        std::set<uint32> ids;
+        std::string value = sConfigMgr->GetOption<std::string>(option, "");
+        for (std::string_view token : Acore::Tokenize(value, ',', false))
+        {
+            if (Optional<uint32> id = Acore::StringTo<uint32>(token))
+                ids.insert(*id);
+        }
+        return ids;
+    };
+
+    std::set<uint32> allowItems = parseIdList("AOELoot.Filter.AllowItems");
+    std::set<uint32> denyItems = parseIdList("AOELoot.Filter.DenyItems");
+    std::set<uint32> denyClasses;
+    std::set<uint32> denySubClasses;
+
+    std::string denyClassRules = sConfigMgr->GetOption<std::string>("AOELoot.Filter.DenyClasses", "");
+    for (std::string_view token : Acore::Tokenize(denyClassRules, ',', false))
     {
-        uint8 lootSlot = loot->items.size() + i;
-        ProcessLootSlot(player, lguid, lootSlot);
-        DebugMessage(player, fmt::format("Looted quest item in slot {}", lootSlot));
+        std::vector<std::string_view> parts = Acore::Tokenize(token, ':', false);
+        Optional<uint32> itemClass = parts.empty() ? std::nullopt : Acore::StringTo<uint32>(parts[0]);
+        if (!itemClass)
+            continue;
+
+        if (parts.size() < 2)
+            denyClasses.insert(*itemClass);
+        else if (Optional<uint32> itemSubClass = Acore::StringTo<uint32>(parts[1]))
+            denySubClasses.insert((*itemClass << 8) | *itemSubClass);
     }
-    
-    const QuestItemMap& ffaItems = loot->GetPlayerFFAItems();
-    for (uint8 i = 0; i < ffaItems.size(); ++i)
+
+    uint32 minQuality = sConfigMgr->GetOption<uint32>("AOELoot.Filter.MinQuality", 0);
+
+    uint32 maxItemId = 0;
+    for (auto const& [itemId, proto] : *itemTemplates)
+        maxItemId = std::max(maxItemId, itemId);
+
+    itemFilterTable.assign(maxItemId + 1, 0);
+
+    uint32 deniedCount = 0;
+    for (auto const& [itemId, proto] : *itemTemplates)
     {
-        ProcessLootSlot(player, lguid, i);
-        DebugMessage(player, fmt::format("Looted FFA item in slot {}", i));
+        uint8 entry = proto.Quality & AOELOOT_FILTER_QUALITY_MASK;
+
+        // >>>>> Explicit lists win, quest items are never dropped by class or quality rules. <<<<< //
+
+        if (allowItems.count(itemId))
+            entry |= AOELOOT_FILTER_ALLOW;
+        else if (denyItems.count(itemId))
+            entry |= AOELOOT_FILTER_DENY;
+        else if (proto.Class == ITEM_CLASS_QUEST || proto.StartQuest)
+            entry |= AOELOOT_FILTER_ALLOW;
+        else if (denyClasses.count(proto.Class) || denySubClasses.count((proto.Class << 8) | proto.SubClass) || proto.Quality < minQuality)
+            entry |= AOELOOT_FILTER_DENY;
+
+        if (entry & AOELOOT_FILTER_DENY)
+            ++deniedCount;
+
+        itemFilterTable[itemId] = entry;
     }
+
+    LOG_INFO("module", "AOELoot: Loaded item filter table for {} items ({} denied server-wide).", itemTemplates->size(), deniedCount);
 }
 
-std::pair<Loot*, bool> AoeLootCommandScript::GetLootObject(Player* player, ObjectGuid lguid)
+bool AoeLootCommandScript::IsItemFiltered(uint32 itemId, uint8 minItemQuality, AoeLootPlayerFilter const* playerFilter)
 {
-    if (lguid.IsGameObject())
-    {
-        
-        // >>>>> This protects against looting Game Objects and Structures <<<<< //
+    if (itemId >= itemFilterTable.size())
+        return false;
 
-        DebugMessage(player, "Skipping GameObject - not supported for AOE loot");
-        return {nullptr, false};
-    }
-    else if (lguid.IsItem())
-    {
-        Item* pItem = player->GetItemByGuid(lguid);
-        if (!pItem)
-        {
-            DebugMessage(player, fmt::format("Failed to find item {}", lguid.ToString()));
-            return {nullptr, false};
+    uint8 entry = itemFilterTable[itemId];
+    if (entry & AOELOOT_FILTER_DENY)
+        return true;
+
+    // >>>>> Player rules come after the table lookup, an item the player denied by ID is always skipped. <<<<< //
+
+    if (playerFilter && playerFilter->denyItems.count(itemId))
+        return true;
+
+    if (entry & AOELOOT_FILTER_ALLOW)
+        return false;
+
+    if ((entry & AOELOOT_FILTER_QUALITY_MASK) < minItemQuality)
+        return true;
+
+    if (!playerFilter || (playerFilter->denyClasses.empty() && playerFilter->denySubClasses.empty()))
+        return false;
+
+    ItemTemplate const* proto = sObjectMgr->GetItemTemplate(itemId);
+    return proto && (playerFilter->denyClasses.count(proto->Class) ||
+        playerFilter->denySubClasses.count((proto->Class << 8) | proto->SubClass));
+}
+
+void AoeLootCommandScript::ProcessQuestItems(Player* player, ObjectGuid lguid, Loot* loot, uint8 minItemQuality, AoeLootPlayerFilter const* playerFilter)
+{
+    if (!player || !loot)
+        return;
+        
+    // >>>>> Quest items sit after the regular items, their client slot is items.size() + position in this player's list. <<<<< //
+
+    QuestItemMap const& questItems = loot->GetPlayerQuestItems();
+    auto questItr = questItems.find(player->GetGUID());
+    if (questItr != questItems.end() && questItr->second)
+    {
+        QuestItemList const& playerQuestItems = *questItr->second;
+        for (size_t i = 0; i < playerQuestItems.size(); ++i)
+        {
+            if (playerQuestItems[i].is_looted)
+                continue;
+
+            StoreLootSlot(player, lguid, loot, loot->items.size() + i);
+        }
+    }
+    
+    // >>>>> FFA items index the regular item list directly and are tracked per player. <<<<< //
+
+    QuestItemMap const& ffaItems = loot->GetPlayerFFAItems();
+    auto ffaItr = ffaItems.find(player->GetGUID());
+    if (ffaItr != ffaItems.end() && ffaItr->second)
+    {
+        for (QuestItem const& ffaItem : *ffaItr->second)
+        {
+            if (ffaItem.is_looted || ffaItem.index >= loot->items.size())
+                continue;
+
+            if (IsItemFiltered(loot->items[ffaItem.index].itemid, minItemQuality, playerFilter))
+                continue;
+
+            StoreLootSlot(player, lguid, loot, ffaItem.index);
+        }
+    }
+}
+
+bool AoeLootCommandScript::StoreLootSlot(Player* player, ObjectGuid lguid, Loot* loot, uint8 lootSlot, AoeLootSweep* sweep)
+{
+    // >>>>> Once the bags are full, skip the placement search and the equip error and queue the item right away <<<<< //
+
+    if (sweep && sweep->overflowMail && sweep->bagsFull && QueueOverflowItem(player, lguid, loot, lootSlot, *sweep))
+        return true;
+
+    InventoryResult msg = EQUIP_ERR_OK;
+    LootItem* storedItem = player->StoreLootItem(lootSlot, loot, msg);
+    if (!storedItem)
+    {
+        DebugMessage(player, fmt::format("Failed to loot slot {} of {}: inventory error {}", lootSlot, lguid.ToString(), static_cast<uint32>(msg)));
+
+        // >>>>> Full bags: hand the item to the overflow mail so the corpse can still be released <<<<< //
+
+        if (sweep && sweep->overflowMail && msg == EQUIP_ERR_INVENTORY_FULL)
+        {
+            sweep->bagsFull = true;
+            return QueueOverflowItem(player, lguid, loot, lootSlot, *sweep);
+        }
+
+        return false;
+    }
+    DebugMessage(player, fmt::format("Looted item from slot {} of {}", lootSlot, lguid.ToString()));
+    return true;
+}
+
+bool AoeLootCommandScript::QueueOverflowItem(Player* player, ObjectGuid lguid, Loot* loot, uint8 lootSlot, AoeLootSweep& sweep)
+{
+    if (lootSlot >= loot->items.size() || (!lguid.IsCreature() && !lguid.IsGameObject()))
+        return false;
+
+    // >>>>> Only plain items can be mailed, quest, FFA and conditional items are tracked per player <<<<< //
+
+    LootItem& lootItem = loot->items[lootSlot];
+    if (lootItem.freeforall || lootItem.needs_quest || !lootItem.conditions.empty() ||
+        lootItem.is_looted || lootItem.is_blocked)
+        return false;
+
+    // >>>>> The bags-full fast path skips StoreLootItem, so its loot rights and unique count checks are repeated here <<<<< //
+
+    if (!lootItem.rollWinnerGUID.IsEmpty() && lootItem.rollWinnerGUID != player->GetGUID())
+        return false;
+
+    if (!lootItem.AllowedForPlayer(player, loot->sourceWorldObjectGUID))
+        return false;
+
+    uint32 queuedCount = lootItem.count;
+    for (AoeLootOverflowItem const& overflowItem : sweep.overflowItems)
+        if (overflowItem.itemId == lootItem.itemid)
+            queuedCount += overflowItem.count;
+
+    if (!player->CanTakeMoreSimilarItems(lootItem.itemid, queuedCount))
+        return false;
+
+    sweep.overflowItems.push_back({ lootItem.itemid, lootItem.count, lootItem.randomPropertyId });
+
+    lootItem.is_looted = true;
+    --loot->unlootedCount;
+    loot->NotifyItemRemoved(lootSlot);
+
+    DebugMessage(player, fmt::format("Queued item {} from slot {} of {} for overflow mail", lootItem.itemid, lootSlot, lguid.ToString()));
+    return true;
+}
+
+void AoeLootCommandScript::SendOverflowMail(Player* player, std::vector<AoeLootOverflowItem> const& overflowItems)
+{
+    if (!player || overflowItems.empty())
+        return;
+
+    // >>>>> Merge plain items into full stacks first so they need as few attachments as possible <<<<< //
+
+    std::vector<AoeLootOverflowItem> stacks;
+    for (AoeLootOverflowItem const& overflowItem : overflowItems)
+    {
+        ItemTemplate const* proto = sObjectMgr->GetItemTemplate(overflowItem.itemId);
+        if (!proto)
+            continue;
+
+        uint32 maxStackSize = std::max<uint32>(proto->GetMaxStackSize(), 1);
+        uint32 count = overflowItem.count;
+
+        if (!overflowItem.randomPropertyId)
+        {
+            for (AoeLootOverflowItem& stack : stacks)
+            {
+                if (!count)
+                    break;
+
+                if (stack.itemId != overflowItem.itemId || stack.randomPropertyId || stack.count >= maxStackSize)
+                    continue;
+
+                uint32 added = std::min(count, maxStackSize - stack.count);
+                stack.count += added;
+                count -= added;
+            }
+        }
+
+        while (count)
+        {
+            uint32 added = std::min(count, maxStackSize);
+            stacks.push_back({ overflowItem.itemId, added, overflowItem.randomPropertyId });
+            count -= added;
+        }
+    }
+
+    if (stacks.empty())
+        return;
+
+    // >>>>> Every mail of the sweep is written in one transaction <<<<< //
+
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+    uint32 mailCount = 0;
+
+    for (size_t first = 0; first < stacks.size(); first += MAX_MAIL_ITEMS)
+    {
+        MailDraft draft("AoE Loot", "Your bags were full, so the loot that didn't fit was sent to you.");
+
+        for (size_t i = first; i < std::min(stacks.size(), first + MAX_MAIL_ITEMS); ++i)
+        {
+            Item* item = Item::CreateItem(stacks[i].itemId, stacks[i].count, player);
+            if (!item)
+                continue;
+
+            if (stacks[i].randomPropertyId)
+                item->SetItemRandomProperties(stacks[i].randomPropertyId);
+
+            item->SaveToDB(trans);
+            draft.AddItem(item);
+        }
+
+        // >>>>> There is no sender to return the mail to, so mark it as already returned like other server mails <<<<< //
+
+        draft.SendMailTo(trans, MailReceiver(player), MailSender(MAIL_NORMAL, 0, MAIL_STATIONERY_GM), MAIL_CHECK_MASK_RETURNED);
+        ++mailCount;
+    }
+
+    CharacterDatabase.CommitTransaction(trans);
+
+    ChatHandler(player->GetSession()).PSendSysMessage("AOE Loot: Your bags are full. {} items were sent to you in {} mails.", overflowItems.size(), mailCount);
+}
+
+std::pair<Loot*, bool> AoeLootCommandScript::GetLootObject(Player* player, ObjectGuid lguid)
+{
+    if (lguid.IsGameObject())
+    {
+        
+        // >>>>> This protects against looting Game Objects and Structures unless GameObject looting is enabled <<<<< //
+
+        if (!sConfigMgr->GetOption<bool>("AOELoot.GameObjects", false))
+        {
+            DebugMessage(player, "Skipping GameObject - not supported for AOE loot");
+            return {nullptr, false};
+        }
+
+        GameObject* go = player->GetMap()->GetGameObject(lguid);
+        if (!go)
+        {
+            DebugMessage(player, fmt::format("Failed to find game object {}", lguid.ToString()));
+            return {nullptr, false};
+        }
+        return {&go->loot, true};
+    }
+    else if (lguid.IsItem())
+    {
+        Item* pItem = player->GetItemByGuid(lguid);
+        if (!pItem)
+        {
+            DebugMessage(player, fmt::format("Failed to find item {}", lguid.ToString()));
+            return {nullptr, false};
         }
         return {&pItem->loot, true};
     }
@@ -488,32 +1134,80 @@ std::pair<Loot*, bool> AoeLootCommandScript::GetLootObject(Player* player, Objec
 
 bool AoeLootCommandScript::HandleStartAoeLootCommand(ChatHandler* handler, Optional<std::string> /*args*/)
 {
-    if (!sConfigMgr->GetOption<bool>("AOELoot.Enable", true))
-        return true;
-
     Player* player = handler->GetSession()->GetPlayer();
     if (!player)
         return true;
 
+    StartAoeLoot(player, ObjectGuid::Empty);
+    return true;
+}
+
+void AoeLootCommandScript::StartAoeLoot(Player* player, ObjectGuid excludedGuid)
+{
+    if (!sConfigMgr->GetOption<bool>("AOELoot.Enable", true))
+        return;
+
     // >>>>> Do not remove the hardcoded value. It is here for crash & data protection. <<<<< //
     
     float range = sConfigMgr->GetOption<float>("AOELoot.Range", 55.0f);
     
     auto validCorpses = GetValidCorpses(player, range);
 
+    std::vector<GameObject*> validGameObjects;
+    if (sConfigMgr->GetOption<bool>("AOELoot.GameObjects", false))
+        validGameObjects = GetValidGameObjects(player, range);
+
     uint32 CorpseThreshold = sConfigMgr->GetOption<uint32>("AOELoot.CorpseThreshold", 2);
     if (validCorpses.size() < CorpseThreshold)
     {
         DebugMessage(player, "Not enough corpses for AOE loot. Defaulting to normal looting.");
-        return true;
+        validCorpses.clear();
     }
+    if (validGameObjects.size() < CorpseThreshold)
+    {
+        if (!validGameObjects.empty())
+            DebugMessage(player, "Not enough game objects for AOE loot. Defaulting to normal looting.");
+        validGameObjects.clear();
+    }
+
+    // >>>>> The node the player used counts toward the threshold but is opened by the core itself. <<<<< //
+
+    validGameObjects.erase(std::remove_if(validGameObjects.begin(), validGameObjects.end(),
+        [excludedGuid](GameObject* go) { return go->GetGUID() == excludedGuid; }), validGameObjects.end());
+
+    if (validCorpses.empty() && validGameObjects.empty())
+        return;
     
+    // >>>>> Money share eligibility only depends on the looter, so resolve it once per sweep. <<<<< //
+
+    AoeLootSweep sweep;
+    sweep.moneyShareMembers = GetMoneyShareMembers(player);
+    sweep.minItemQuality = GetPlayerAoeLootQuality(player->GetGUID().GetRawValue());
+    sweep.playerFilter = GetPlayerAoeLootFilter(player->GetGUID().GetRawValue());
+    sweep.overflowMail = sConfigMgr->GetOption<bool>("AOELoot.OverflowMail", false);
+
     for (auto* creature : validCorpses)
     {
-        ProcessCreatureLoot(player, creature);
+        ProcessCreatureLoot(player, creature, sweep);
     }
-    
-    return true;
+
+    for (auto* go : validGameObjects)
+    {
+        ProcessGameObjectLoot(player, go, sweep);
+    }
+
+    // >>>>> Release every fully looted corpse and node in one batch once the sweep is done. <<<<< //
+
+    ProcessLootRelease(player, sweep.releasedCorpses);
+    ProcessGameObjectRelease(player, sweep.releasedGameObjects);
+
+    // >>>>> Corpses emptied above are skinnable now, so the skinning sweep runs after the release. <<<<< //
+
+    if (sConfigMgr->GetOption<bool>("AOELoot.Skinning", false))
+        ProcessSkinningSweep(player, range, sweep);
+
+    ApplySkillUps(player, sweep.skillUps);
+    SendOverflowMail(player, sweep.overflowItems);
 }
 
 std::vector<Creature*> AoeLootCommandScript::GetValidCorpses(Player* player, float range)
@@ -534,7 +1228,407 @@ std::vector<Creature*> AoeLootCommandScript::GetValidCorpses(Player* player, flo
     return validCorpses;
 }
 
-void AoeLootCommandScript::ProcessCreatureLoot(Player* player, Creature* creature)
+// >>>>> The group sweep checks group tap rights itself, isAllowedToLoot would drop corpses owned by another member's round robin turn. <<<<< //
+
+std::vector<Creature*> AoeLootCommandScript::GetGroupCorpses(Player* player, Group* group, float range)
+{
+    std::list<Creature*> nearbyCorpses;
+    player->GetDeadCreatureListInGrid(nearbyCorpses, range);
+
+    std::vector<Creature*> groupCorpses;
+    for (auto* creature : nearbyCorpses)
+    {
+        if (creature->IsAlive() || !creature->HasDynamicFlag(UNIT_DYNFLAG_LOOTABLE))
+            continue;
+
+        if (creature->loot.empty() || creature->loot.isLooted())
+            continue;
+
+        if (creature->GetLootRecipientGroup() != group)
+            continue;
+
+        groupCorpses.push_back(creature);
+    }
+
+    DebugMessage(player, fmt::format("Found {} group corpses within range {}", groupCorpses.size(), range));
+    return groupCorpses;
+}
+
+// >>>>> Grid check for lootable chests and gathering nodes around the player. <<<<< //
+
+class AoeLootGameObjectCheck
+{
+public:
+    AoeLootGameObjectCheck(Player* player, float range) : _player(player), _range(range) {}
+
+    bool operator()(GameObject* go) const
+    {
+        return go->GetGoType() == GAMEOBJECT_TYPE_CHEST && go->isSpawned() && _player->IsWithinDistInMap(go, _range);
+    }
+
+private:
+    Player* _player;
+    float _range;
+};
+
+std::vector<GameObject*> AoeLootCommandScript::GetValidGameObjects(Player* player, float range)
+{
+    std::list<GameObject*> nearbyObjects;
+    AoeLootGameObjectCheck check(player, range);
+    Acore::GameObjectListSearcher<AoeLootGameObjectCheck> searcher(player, nearbyObjects, check);
+    Cell::VisitGridObjects(player, searcher, range);
+
+    DebugMessage(player, fmt::format("Found {} nearby game objects within range {}", nearbyObjects.size(), range));
+
+    std::vector<GameObject*> validGameObjects;
+    for (auto* go : nearbyObjects)
+    {
+        uint32 skillId = SKILL_NONE;
+        uint32 reqSkillValue = 0;
+        if (IsValidGameObjectTarget(player, go, skillId, reqSkillValue))
+            validGameObjects.push_back(go);
+    }
+
+    DebugMessage(player, fmt::format("Found {} valid game objects", validGameObjects.size()));
+    return validGameObjects;
+}
+
+// >>>>> Gathering tools, herbalism and engineering need none. <<<<< //
+
+static bool HasGatherTool(Player* player, uint32 skillId)
+{
+    switch (skillId)
+    {
+        case SKILL_SKINNING:
+            return player->HasItemTotemCategory(TC_SKINNING_SKIFE_OLD) || player->HasItemTotemCategory(TC_SKINNING_SKIFE);
+        case SKILL_MINING:
+            return player->HasItemTotemCategory(TC_MINING_PICK_OLD) || player->HasItemTotemCategory(TC_HAMMER_PICK) ||
+                player->HasItemTotemCategory(TC_BLADED_PICKAXE);
+        default:
+            return true;
+    }
+}
+
+bool AoeLootCommandScript::IsValidGameObjectTarget(Player* player, GameObject* go, uint32& skillId, uint32& reqSkillValue)
+{
+    if (!player || !go)
+        return false;
+
+    GameObjectTemplate const* goInfo = go->GetGOInfo();
+    if (!goInfo || !goInfo->GetLootId() || go->getLootState() != GO_READY)
+        return false;
+
+    if (go->HasGameObjectFlag(GameObjectFlags(GO_FLAG_IN_USE | GO_FLAG_LOCKED | GO_FLAG_INTERACT_COND | GO_FLAG_NOT_SELECTABLE)))
+        return false;
+
+    // >>>>> Chests with group loot rules and quest chests keep going through the normal looting logic. <<<<< //
+
+    if ((goInfo->chest.groupLootRules && player->GetGroup()) || goInfo->chest.questId)
+        return false;
+
+    // >>>>> Opening a chest can start an event or run GO AI and gossip scripts, the sweep skips all of those. <<<<< //
+
+    if (goInfo->chest.eventId || goInfo->ScriptId || !goInfo->AIName.empty())
+        return false;
+
+    // >>>>> Only unlocked chests, herbs and ore the player has the skill (and for ore, a pick) for can be opened. <<<<< //
+    // >>>>> Keys and the generic Opening spell need a real cast, so those locks are left alone. <<<<< //
+
+    skillId = SKILL_NONE;
+    reqSkillValue = 0;
+
+    LockEntry const* lockInfo = sLockStore.LookupEntry(goInfo->GetLockId());
+    if (!lockInfo)
+        return true;
+
+    bool hasLockCase = false;
+    for (uint8 j = 0; j < MAX_LOCK_CASE; ++j)
+    {
+        switch (lockInfo->Type[j])
+        {
+            case LOCK_KEY_ITEM:
+                hasLockCase = true;
+                break;
+            case LOCK_KEY_SKILL:
+            {
+                hasLockCase = true;
+                uint32 lockSkill = SkillByLockType(LockType(lockInfo->Index[j]));
+                if (lockSkill != SKILL_HERBALISM && lockSkill != SKILL_MINING)
+                    break;
+
+                if (lockSkill == SKILL_MINING && !HasGatherTool(player, SKILL_MINING))
+                    break;
+
+                if (player->GetSkillValue(lockSkill) >= lockInfo->Skill[j])
+                {
+                    skillId = lockSkill;
+                    reqSkillValue = lockInfo->Skill[j];
+                    return true;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    return !hasLockCase;
+}
+
+void AoeLootCommandScript::ProcessGameObjectLoot(Player* player, GameObject* go, AoeLootSweep& sweep)
+{
+    uint32 skillId = SKILL_NONE;
+    uint32 reqSkillValue = 0;
+    if (!IsValidGameObjectTarget(player, go, skillId, reqSkillValue))
+        return;
+
+    ObjectGuid lguid = go->GetGUID();
+    Loot* loot = &go->loot;
+
+    // >>>>> Generate the loot the same way the core does when a node is opened, but keep it personal <<<<< //
+
+    loot->clear();
+    loot->FillLoot(go->GetGOInfo()->GetLootId(), LootTemplates_Gameobject, player, true, false, go->GetLootMode(), go);
+    go->SetLootGenerationTime();
+
+    if (GameObjectTemplateAddon const* addon = go->GetTemplateAddon())
+        loot->generateMoneyLoot(addon->mingold, addon->maxgold);
+
+    go->SetLootState(GO_ACTIVATED, player);
+
+    // >>>>> Allow one skill-up per node until it respawns, applied once the sweep is done <<<<< //
+
+    if (skillId != SKILL_NONE && !go->IsInSkillupList(player->GetGUID()))
+    {
+        go->AddToSkillupList(player->GetGUID());
+        sweep.skillUps.push_back({ skillId, reqSkillValue, 1 });
+    }
+
+    ProcessQuestItems(player, lguid, loot, sweep.minItemQuality, sweep.playerFilter);
+
+    for (uint8 lootSlot = 0; lootSlot < loot->items.size(); ++lootSlot)
+    {
+        if (loot->items[lootSlot].freeforall)
+            continue;
+
+        if (IsItemFiltered(loot->items[lootSlot].itemid, sweep.minItemQuality, sweep.playerFilter))
+        {
+            DebugMessage(player, fmt::format("Skipped filtered item {} in slot {}", loot->items[lootSlot].itemid, lootSlot));
+            continue;
+        }
+
+        // >>>>> Gathered loot is personal, so skip the group rules in ProcessLootSlot and store directly <<<<< //
+
+        if (!loot->items[lootSlot].is_looted && !loot->items[lootSlot].is_blocked)
+            StoreLootSlot(player, lguid, loot, lootSlot, &sweep);
+    }
+
+    if (loot->gold > 0)
+    {
+        // >>>>> An empty share list gives all of the money to the looter <<<<< //
+
+        ProcessLootMoney(player, loot, {});
+    }
+
+    sweep.releasedGameObjects.push_back(go);
+}
+
+std::vector<Item*> AoeLootCommandScript::GetLootableContainers(Player* player)
+{
+    std::vector<Item*> containers;
+
+    auto addIfLootable = [player, &containers](Item* item)
+    {
+        if (item && IsLootableContainer(player, item))
+            containers.push_back(item);
+    };
+
+    for (uint8 slot = INVENTORY_SLOT_ITEM_START; slot < INVENTORY_SLOT_ITEM_END; ++slot)
+        addIfLootable(player->GetItemByPos(INVENTORY_SLOT_BAG_0, slot));
+
+    for (uint8 bagSlot = INVENTORY_SLOT_BAG_START; bagSlot < INVENTORY_SLOT_BAG_END; ++bagSlot)
+    {
+        Bag* bag = player->GetBagByPos(bagSlot);
+        if (!bag)
+            continue;
+
+        for (uint32 slot = 0; slot < bag->GetBagSize(); ++slot)
+            addIfLootable(bag->GetItemByPos(slot));
+    }
+
+    DebugMessage(player, fmt::format("Found {} lootable containers", containers.size()));
+    return containers;
+}
+
+bool AoeLootCommandScript::IsLootableContainer(Player* player, Item* item)
+{
+    ItemTemplate const* proto = item->GetTemplate();
+    if (!proto || !(proto->Flags & ITEM_FLAG_HAS_LOOT))
+        return false;
+
+    // >>>>> Same checks the core runs before opening an item: no locked, wrapped or traded containers. <<<<< //
+
+    if (proto->LockID && item->IsLocked())
+        return false;
+
+    if (item->HasFlag(ITEM_FIELD_FLAGS, ITEM_FIELD_FLAG_WRAPPED) || item->IsInTrade())
+        return false;
+
+    return item->GetOwnerGUID() == player->GetGUID();
+}
+
+bool AoeLootCommandScript::ProcessContainerLoot(Player* player, Item* item, AoeLootSweep& sweep)
+{
+    ObjectGuid lguid = item->GetGUID();
+    Loot* loot = &item->loot;
+    ItemTemplate const* proto = item->GetTemplate();
+
+    // >>>>> The container GUID keys the stored loot. The core sets it on every open, also when stored loot is loaded <<<<< //
+
+    loot->containerGUID = lguid;
+
+    // >>>>> Generate the loot the same way the core does when an item is opened, stored loot is reused <<<<< //
+
+    if (!item->m_lootGenerated && !sLootItemStorage->LoadStoredLoot(item, player))
+    {
+        item->m_lootGenerated = true;
+        loot->clear();
+        loot->generateMoneyLoot(proto->MinMoneyLoot, proto->MaxMoneyLoot);
+        loot->FillLoot(item->GetEntry(), LootTemplates_Item, player, true, loot->gold != 0);
+
+        // >>>>> Save the rolled loot so nothing is lost if the container can't be emptied <<<<< //
+
+        if (loot->gold > 0 || loot->unlootedCount > 0)
+            sLootItemStorage->AddNewStoredLoot(loot, player);
+    }
+
+    uint32 unlootedBefore = loot->unlootedCount;
+
+    ProcessQuestItems(player, lguid, loot, 0, nullptr);
+
+    for (uint8 lootSlot = 0; lootSlot < loot->items.size(); ++lootSlot)
+    {
+        if (loot->items[lootSlot].freeforall || loot->items[lootSlot].is_looted || loot->items[lootSlot].is_blocked)
+            continue;
+
+        StoreLootSlot(player, lguid, loot, lootSlot);
+    }
+
+    sweep.lootedItemCount += unlootedBefore - loot->unlootedCount;
+
+    if (loot->gold > 0)
+    {
+        sweep.lootedMoney += loot->gold;
+        ProcessLootMoney(player, loot, {});
+        sLootItemStorage->RemoveStoredLootMoneyForContainer(lguid.GetCounter());
+    }
+
+    // >>>>> Only delete the container once it is empty, unlooted loot stays saved on it <<<<< //
+
+    if (!loot->isLooted())
+    {
+        DebugMessage(player, fmt::format("Container {} still has loot left", lguid.ToString()));
+        return false;
+    }
+
+    player->DestroyItem(item->GetBagSlot(), item->GetSlot(), true);
+    DebugMessage(player, fmt::format("Opened container {}", lguid.ToString()));
+    return true;
+}
+
+void AoeLootCommandScript::ProcessSkinningSweep(Player* player, float range, AoeLootSweep& sweep)
+{
+    // >>>>> Skill values and tools only change between sweeps, so look them up once. <<<<< //
+
+    std::map<uint32, uint32> skillValues;
+    for (uint32 skillId : { SKILL_SKINNING, SKILL_MINING, SKILL_HERBALISM, SKILL_ENGINEERING })
+    {
+        uint32 skillValue = player->GetSkillValue(skillId);
+        if (skillValue && HasGatherTool(player, skillId))
+            skillValues[skillId] = skillValue;
+    }
+
+    if (skillValues.empty())
+    {
+        DebugMessage(player, "No gathering skill available for the skinning sweep.");
+        return;
+    }
+
+    std::list<Creature*> nearbyCorpses;
+    player->GetDeadCreatureListInGrid(nearbyCorpses, range);
+
+    std::vector<Creature*> skinnedCorpses;
+    for (auto* creature : nearbyCorpses)
+    {
+        if (ProcessSkinningLoot(player, creature, skillValues, sweep))
+            skinnedCorpses.push_back(creature);
+    }
+
+    DebugMessage(player, fmt::format("Gathered {} of {} nearby corpses", skinnedCorpses.size(), nearbyCorpses.size()));
+
+    ProcessLootRelease(player, skinnedCorpses);
+}
+
+bool AoeLootCommandScript::ProcessSkinningLoot(Player* player, Creature* creature, std::map<uint32, uint32> const& skillValues, AoeLootSweep& sweep)
+{
+    if (!creature || creature->IsAlive() || !creature->HasUnitFlag(UNIT_FLAG_SKINNABLE))
+        return false;
+
+    // >>>>> Same requirements the core checks before a skinning cast. <<<<< //
+
+    if (creature->GetCreatureType() != CREATURE_TYPE_CRITTER && !creature->loot.isLooted())
+        return false;
+
+    CreatureTemplate const* creatureInfo = creature->GetCreatureTemplate();
+    if (!creatureInfo->SkinLootId)
+        return false;
+
+    uint32 skillId = creatureInfo->GetRequiredLootSkill();
+    auto skillItr = skillValues.find(skillId);
+    if (skillItr == skillValues.end())
+        return false;
+
+    int32 skillValue = skillItr->second;
+    int32 targetLevel = creature->GetLevel();
+    int32 reqValue = skillValue < 100 ? (targetLevel - 10) * 10 : targetLevel * 5;
+    if (reqValue > skillValue)
+        return false;
+
+    ObjectGuid lguid = creature->GetGUID();
+    Loot* loot = &creature->loot;
+
+    // >>>>> Generate the secondary loot like a finished skinning cast does <<<<< //
+
+    creature->RemoveUnitFlag(UNIT_FLAG_SKINNABLE);
+    creature->SetDynamicFlag(UNIT_DYNFLAG_LOOTABLE);
+
+    loot->clear();
+    loot->FillLoot(creatureInfo->SkinLootId, LootTemplates_Skinning, player, true);
+    loot->loot_type = LOOT_SKINNING;
+    creature->SetLootRecipient(player, false);
+
+    uint32 unlootedBefore = loot->unlootedCount;
+
+    for (uint8 lootSlot = 0; lootSlot < loot->items.size(); ++lootSlot)
+    {
+        if (loot->items[lootSlot].is_looted || loot->items[lootSlot].is_blocked)
+            continue;
+
+        StoreLootSlot(player, lguid, loot, lootSlot, &sweep);
+    }
+
+    sweep.lootedItemCount += unlootedBefore - loot->unlootedCount;
+
+    // >>>>> Skill-ups use the cast formula and are applied together once the sweep is done <<<<< //
+
+    int32 skillUpReqValue = targetLevel < 10 ? 0 : targetLevel < 20 ? (targetLevel - 10) * 10 : targetLevel * 5;
+    sweep.skillUps.push_back({ skillId, uint32(skillUpReqValue), creature->isElite() ? 2u : 1u });
+
+    DebugMessage(player, fmt::format("Gathered {} with skill {}", creature->GetName(), skillId));
+    return true;
+}
+
+void AoeLootCommandScript::ProcessCreatureLoot(Player* player, Creature* creature, AoeLootSweep& sweep)
 {
     ObjectGuid lguid = creature->GetGUID();
     Loot* loot = &creature->loot;
@@ -550,25 +1644,38 @@ void AoeLootCommandScript::ProcessCreatureLoot(Player* player, Creature* creatur
 
     player->SetLootGUID(lguid);
     
-    ProcessQuestItems(player, lguid, loot);
+    ProcessQuestItems(player, lguid, loot, sweep.minItemQuality, sweep.playerFilter);
     
     for (uint8 lootSlot = 0; lootSlot < loot->items.size(); ++lootSlot)
     {
 
+        // >>>>> FFA items were already handled by the per-player fast path <<<<< //
+
+        if (loot->items[lootSlot].freeforall)
+            continue;
+
+        // >>>>> Filtered items stay on the corpse, the table lookup happens before any inventory work <<<<< //
+
+        if (IsItemFiltered(loot->items[lootSlot].itemid, sweep.minItemQuality, sweep.playerFilter))
+        {
+            DebugMessage(player, fmt::format("Skipped filtered item {} in slot {}", loot->items[lootSlot].itemid, lootSlot));
+            continue;
+        }
+
         // >>>>> Reset loot GUID for each item to ensure proper group roll handling <<<<< //
 
         player->SetLootGUID(lguid);
-        ProcessLootSlot(player, lguid, lootSlot);
+        ProcessLootSlot(player, lguid, lootSlot, &sweep);
     }
     
     if (loot->gold > 0)
     {
-        ProcessLootMoney(player, creature);
+        ProcessLootMoney(player, loot, sweep.moneyShareMembers);
     }
     
     if (loot->isLooted())
     {
-        ProcessLootRelease(lguid, player, loot);
+        sweep.releasedCorpses.push_back(creature);
     }
     
     // >>>>> Restore original loot GUID after processing <<<<< //
@@ -576,7 +1683,72 @@ void AoeLootCommandScript::ProcessCreatureLoot(Player* player, Creature* creatur
     player->SetLootGUID(originalLootGuid);
 }
 
-bool AoeLootCommandScript::ProcessLootSlot(Player* player, ObjectGuid lguid, uint8 lootSlot)
+void AoeLootCommandScript::ProcessGroupCreatureLoot(Player* player, Creature* creature, AoeLootSweep& sweep)
+{
+    ObjectGuid lguid = creature->GetGUID();
+    Loot* loot = &creature->loot;
+    Group* group = player->GetGroup();
+
+    // >>>>> Items only go to members within AOELoot.Range of this corpse, money keeps the wider share range <<<<< //
+
+    float range = sConfigMgr->GetOption<float>("AOELoot.Range", 55.0f);
+    std::vector<Player*> members;
+    for (Player* member : sweep.moneyShareMembers)
+    {
+        if (member->IsWithinDistInMap(creature, range))
+            members.push_back(member);
+    }
+
+    if (members.empty())
+        members.push_back(player);
+
+    // >>>>> Quest and FFA items are tracked per player, so every member in range takes their own <<<<< //
+
+    for (Player* member : members)
+    {
+        uint64 memberGuid = member->GetGUID().GetRawValue();
+        ProcessQuestItems(member, lguid, loot, GetPlayerAoeLootQuality(memberGuid), GetPlayerAoeLootFilter(memberGuid));
+    }
+
+    for (uint8 lootSlot = 0; lootSlot < loot->items.size(); ++lootSlot)
+    {
+        LootItem& lootItem = loot->items[lootSlot];
+        if (lootItem.freeforall || lootItem.is_looted || lootItem.is_blocked)
+            continue;
+
+        if (IsItemFiltered(lootItem.itemid, 0))
+            continue;
+
+        // >>>>> Master loot: items the core marked at or above the threshold are left for the master looter to assign <<<<< //
+
+        if (group->GetLootMethod() == MASTER_LOOT && !lootItem.is_underthreshold)
+            continue;
+
+        // >>>>> Everything else goes round robin to the members in range, the next member tries if one can't take it <<<<< //
+
+        for (size_t attempt = 0; attempt < members.size(); ++attempt)
+        {
+            Player* member = members[sweep.nextRecipient++ % members.size()];
+            if (!lootItem.AllowedForPlayer(member, lguid))
+                continue;
+
+            if (StoreLootSlot(member, lguid, loot, lootSlot))
+                break;
+        }
+    }
+
+    if (loot->gold > 0)
+    {
+        ProcessLootMoney(player, loot, sweep.moneyShareMembers);
+    }
+
+    if (loot->isLooted())
+    {
+        sweep.releasedCorpses.push_back(creature);
+    }
+}
+
+bool AoeLootCommandScript::ProcessLootSlot(Player* player, ObjectGuid lguid, uint8 lootSlot, AoeLootSweep* sweep)
 {
     if (!player)
         return false;
@@ -585,7 +1757,7 @@ bool AoeLootCommandScript::ProcessLootSlot(Player* player, ObjectGuid lguid, uin
 
      // >>>>> Basic validation checks <<<<< //
 
-    if (!player || !lguid || lguid.IsEmpty())
+    if (!player || !lguid || lguid.IsEmpty() || !isValid || !loot)
     {
         DebugMessage(player, fmt::format("Failed to loot slot {} of {}: invalid loot object", lootSlot, lguid.ToString()));
         return false;
@@ -603,7 +1775,6 @@ bool AoeLootCommandScript::ProcessLootSlot(Player* player, ObjectGuid lguid, uin
 
     Group* group = player->GetGroup();
     LootItem& lootItem = loot->items[lootSlot];
-    InventoryResult msg = EQUIP_ERR_OK;
 
     if (lootItem.is_blocked || lootItem.is_looted)
     {
@@ -616,6 +1787,11 @@ bool AoeLootCommandScript::ProcessLootSlot(Player* player, ObjectGuid lguid, uin
     bool isRoundRobin = false;
     LootMethod lootMethod = GROUP_LOOT;
     
+    // >>>>> Group loot rules only apply to creature loot, gathered and container loot is personal <<<<< //
+
+    if (!lguid.IsCreature())
+        group = nullptr;
+
     if (group)
     {
         lootMethod = group->GetLootMethod();
@@ -655,96 +1831,95 @@ bool AoeLootCommandScript::ProcessLootSlot(Player* player, ObjectGuid lguid, uin
         return false;
     }
 
-    LootItem* storedItem = player->StoreLootItem(lootSlot, loot, msg);
-    if (!storedItem)
-    {
-        DebugMessage(player, fmt::format("Failed to loot slot {} of {}: inventory error {}", lootSlot, lguid.ToString(), static_cast<uint32>(msg)));
-        return false;
-    }
-    DebugMessage(player, fmt::format("Looted item from slot {} of {}", lootSlot, lguid.ToString()));
-    return true;
+    return StoreLootSlot(player, lguid, loot, lootSlot, sweep);
 }
 
-bool AoeLootCommandScript::ProcessLootMoney(Player* player, Creature* creature)
+bool AoeLootCommandScript::ProcessLootMoney(Player* player, Loot* loot, std::vector<Player*> const& moneyShareMembers)
 {
-    if (!player || !creature || creature->loot.gold == 0)
+    if (!player || !loot || loot->gold == 0)
         return false;
         
-    uint32 goldAmount = creature->loot.gold;
-    Group* group = player->GetGroup();
+    uint32 goldAmount = loot->gold;
     
-    if (group && sConfigMgr->GetOption<bool>("AOELoot.Group", true))
+    if (!moneyShareMembers.empty())
     {
-        std::vector<Player*> eligibleMembers;
-
-        // >>>>> For AoE loot, we allow money sharing within a larger range. <<<<< //
-        
-        float range = sConfigMgr->GetOption<float>("AOELoot.Range", 55.0f);
-        float moneyShareMultiplier = sConfigMgr->GetOption<float>("AOELoot.MoneyShareDistanceMultiplier", 2.0f);
-        float moneyRange = range * moneyShareMultiplier;
-        
-        for (GroupReference* itr = group->GetFirstMember(); itr != nullptr; itr = itr->next())
+        uint32 goldPerPlayer = goldAmount / moneyShareMembers.size();
+        for (Player* member : moneyShareMembers)
         {
-            Player* member = itr->GetSource();
-            if (member && member->IsInWorld() && !member->isDead())
-            {
-                // >>>>> Check if the member is eligible for money sharing <<<<< //
-                
-                if (member->IsWithinDistInMap(player, moneyRange) || 
-                    member->IsAtLootRewardDistance(player))
-                {
-                    eligibleMembers.push_back(member);
-                }
-            }
-        }
-        
-        if (!eligibleMembers.empty())
-        {
-            uint32 goldPerPlayer = goldAmount / eligibleMembers.size();
-            for (Player* member : eligibleMembers)
-            {
-                member->ModifyMoney(goldPerPlayer);
-                member->UpdateAchievementCriteria(ACHIEVEMENT_CRITERIA_TYPE_LOOT_MONEY, goldPerPlayer);
-                DebugMessage(member, fmt::format("Received {} copper from AOE loot", goldPerPlayer));
-            }
-        }
-        else
-        {
-            // >>>>> Fallback: give all money to the looter if no eligible members found <<<<< //
-            
-            player->ModifyMoney(goldAmount);
-            player->UpdateAchievementCriteria(ACHIEVEMENT_CRITERIA_TYPE_LOOT_MONEY, goldAmount);
+            member->ModifyMoney(goldPerPlayer);
+            member->UpdateAchievementCriteria(ACHIEVEMENT_CRITERIA_TYPE_LOOT_MONEY, goldPerPlayer);
+            DebugMessage(member, fmt::format("Received {} copper from AOE loot", goldPerPlayer));
         }
     }
     else
     {
+        // >>>>> Fallback: give all money to the looter if no eligible members found <<<<< //
+
         player->ModifyMoney(goldAmount);
         player->UpdateAchievementCriteria(ACHIEVEMENT_CRITERIA_TYPE_LOOT_MONEY, goldAmount);
     }
     
-    creature->loot.gold = 0;
+    loot->gold = 0;
     return true;
 }
 
-void AoeLootCommandScript::ProcessLootRelease(ObjectGuid lguid, Player* player, Loot* loot)
+void AoeLootCommandScript::ProcessLootRelease(Player* player, std::vector<Creature*> const& releasedCorpses)
 {
-    if (!player || !loot)
+    if (!player || releasedCorpses.empty())
         return;
-        
-    player->SetLootGUID(ObjectGuid::Empty);
-    player->SendLootRelease(lguid);
+
+    // >>>>> Release responses only go to the looter, so send them before touching the corpses. <<<<< //
+
+    for (Creature* creature : releasedCorpses)
+    {
+        if (player->GetLootGUID() == creature->GetGUID())
+            player->SetLootGUID(ObjectGuid::Empty);
+
+        player->SendLootRelease(creature->GetGUID());
+    }
+
+    // >>>>> Flag changes are applied back to back so nearby players receive them in a single update-object pass. <<<<< //
+
+    for (Creature* creature : releasedCorpses)
+    {
+        if (!creature->loot.isLooted())
+            continue;
+
+        creature->RemoveDynamicFlag(UNIT_DYNFLAG_LOOTABLE);
+        creature->AllLootRemovedFromCorpse();
+    }
     
-    if (lguid.IsCreature())
+    DebugMessage(player, fmt::format("Released loot for {} corpses", releasedCorpses.size()));
+}
+
+void AoeLootCommandScript::ProcessGameObjectRelease(Player* player, std::vector<GameObject*> const& releasedGameObjects)
+{
+    if (!player || releasedGameObjects.empty())
+        return;
+
+    // >>>>> Fully looted nodes despawn, anything left behind stays open for normal looting. <<<<< //
+
+    for (GameObject* go : releasedGameObjects)
     {
-        Creature* creature = player->GetMap()->GetCreature(lguid);
-        if (creature && loot->isLooted())
+        if (go->loot.isLooted())
         {
-            creature->RemoveDynamicFlag(UNIT_DYNFLAG_LOOTABLE);
-            creature->AllLootRemovedFromCorpse();
+            go->SetLootState(GO_JUST_DEACTIVATED);
+            go->loot.clear();
         }
     }
-    
-    DebugMessage(player, fmt::format("Released loot for {}", lguid.ToString()));
+
+    DebugMessage(player, fmt::format("Released loot for {} game objects", releasedGameObjects.size()));
+}
+
+void AoeLootCommandScript::ApplySkillUps(Player* player, std::vector<AoeLootSkillUp> const& skillUps)
+{
+    if (!player)
+        return;
+
+    for (AoeLootSkillUp const& skillUp : skillUps)
+    {
+        player->UpdateGatherSkill(skillUp.skillId, player->GetPureSkillValue(skillUp.skillId), skillUp.reqSkillValue, skillUp.multiplicator);
+    }
 }
 
 void AoeLootPlayer::OnPlayerLogin(Player* player)
@@ -756,6 +1931,24 @@ void AoeLootPlayer::OnPlayerLogin(Player* player)
     }
 }
 
+void AoeLootPlayer::OnPlayerSpellCast(Player* player, Spell* spell, bool /*skipCheck*/)
+{
+    if (!sConfigMgr->GetOption<bool>("AOELoot.GameObjects", false))
+        return;
+
+    // >>>>> Herbs, ore and locked chests are opened with a spell, not CMSG_GAMEOBJ_USE. The targeted node is left to the spell. <<<<< //
+
+    GameObject* go = spell->m_targets.GetGOTarget();
+    if (!go || go->GetGoType() != GAMEOBJECT_TYPE_CHEST || !spell->GetSpellInfo()->HasEffect(SPELL_EFFECT_OPEN_LOCK))
+        return;
+
+    if (AoeLootCommandScript::IsPlayerAoeLootActive(player))
+    {
+        AoeLootCommandScript::DebugMessage(player, "AOE Looting started.");
+        AoeLootCommandScript::StartAoeLoot(player, go->GetGUID());
+    }
+}
+
 void AoeLootPlayer::OnPlayerLogout(Player* player)
     {
         uint64 guid = player->GetGUID().GetRawValue();
@@ -766,6 +1959,8 @@ void AoeLootPlayer::OnPlayerLogout(Player* player)
             AoeLootCommandScript::RemovePlayerLootEnabled(guid);
         if (AoeLootCommandScript::hasPlayerAoeLootDebug(guid))
             AoeLootCommandScript::RemovePlayerLootDebug(guid);
+        AoeLootCommandScript::RemovePlayerLootQuality(guid);
+        AoeLootCommandScript::RemovePlayerLootFilter(guid);
     }
 
 // Helper functions end. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
@@ -778,5 +1973,6 @@ void AddSC_AoeLoot()
 {
     new AoeLootPlayer();
     new AoeLootManager();
+    new AoeLootWorld();
     new AoeLootCommandScript();
 }
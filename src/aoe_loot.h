@@ -4,6 +4,7 @@
 #include "ScriptMgr.h"
 #include "Config.h"
 #include "ServerScript.h"
+#include "WorldScript.h"
 #include "Chat.h"
 #include "Player.h"
 #include "Item.h"
@@ -14,11 +15,74 @@
 #include <vector> 
 #include <list>
 #include <map>
+#include <set>
 #include <ObjectGuid.h>
 
 using namespace Acore::ChatCommands;
 
 
+// AoeLootSkillUp Struct >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
+struct AoeLootSkillUp
+{
+    uint32 skillId;
+    uint32 reqSkillValue;
+    uint32 multiplicator;
+};
+
+// AoeLootSkillUp Struct End. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
+
+// AoeLootOverflowItem Struct >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
+struct AoeLootOverflowItem
+{
+    uint32 itemId;
+    uint32 count;
+    int32 randomPropertyId;
+};
+
+// AoeLootOverflowItem Struct End. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
+
+// AoeLootPlayerFilter Struct >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
+// >>>>> Per-player deny rules, checked after the server-wide item filter table. <<<<< //
+
+struct AoeLootPlayerFilter
+{
+    std::set<uint32> denyItems;
+    std::set<uint32> denyClasses;
+    std::set<uint32> denySubClasses;
+
+    bool empty() const { return denyItems.empty() && denyClasses.empty() && denySubClasses.empty(); }
+};
+
+// AoeLootPlayerFilter Struct End. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
+
+// AoeLootSweep Struct >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
+// >>>>> State collected while one AOE loot sweep runs and finalized once it ends. <<<<< //
+
+struct AoeLootSweep
+{
+    std::vector<Creature*> releasedCorpses;
+    std::vector<GameObject*> releasedGameObjects;
+    std::vector<AoeLootSkillUp> skillUps;
+    std::vector<AoeLootOverflowItem> overflowItems;
+    bool overflowMail = false;
+    bool bagsFull = false;
+    uint32 nextRecipient = 0;
+    std::vector<Player*> moneyShareMembers;
+    uint8 minItemQuality = 0;
+    AoeLootPlayerFilter const* playerFilter = nullptr;
+    uint32 lootedItemCount = 0;
+    uint32 lootedMoney = 0;
+};
+
+// AoeLootSweep Struct End. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
 // AoeLootManager Class >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
 
 class AoeLootManager : public ServerScript
@@ -33,6 +97,20 @@ public:
 // AoeLootManager Class End. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
 
 
+// AoeLootWorld Class >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
+class AoeLootWorld : public WorldScript
+{
+public:
+    AoeLootWorld() : WorldScript("AoeLootWorld") {}
+
+    void OnAfterConfigLoad(bool reload) override;
+    void OnStartup() override;
+};
+
+// AoeLootWorld Class End. >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
+
+
 // AoeLootPlayer Class >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> //
 
 class AoeLootPlayer : public PlayerScript
@@ -41,6 +119,7 @@ public:
     AoeLootPlayer() : PlayerScript("AoeLootPlayer") {}
 
     void OnPlayerLogin(Player* player) override;
+    void OnPlayerSpellCast(Player* player, Spell* spell, bool skipCheck) override;
     void OnPlayerLogout(Player* player) override;
 };
 
@@ -63,20 +142,48 @@ public:
     static bool HandleAoeLootDebugOnCommand(ChatHandler* handler, Optional<std::string> args);
     static bool HandleAoeLootDebugOffCommand(ChatHandler* handler, Optional<std::string> args);
     static bool HandleAoeLootDebugToggleCommand(ChatHandler* handler, Optional<std::string> args);
+    static bool HandleAoeLootQualityCommand(ChatHandler* handler, Optional<uint8> quality);
+    static bool HandleAoeLootFilterItemCommand(ChatHandler* handler, uint32 itemId);
+    static bool HandleAoeLootFilterClassCommand(ChatHandler* handler, uint32 itemClass, Optional<uint32> itemSubClass);
+    static bool HandleAoeLootFilterClearCommand(ChatHandler* handler, Optional<std::string> args);
+    static bool HandleAoeLootOpenCommand(ChatHandler* handler, Optional<std::string> args);
+    static bool HandleAoeLootSkinCommand(ChatHandler* handler, Optional<std::string> args);
+    static bool HandleAoeLootGroupCommand(ChatHandler* handler, Optional<std::string> args);
     
     // Core loot processing functions
-    static bool ProcessLootSlot(Player* player, ObjectGuid lguid, uint8 lootSlot);
-    static bool ProcessLootMoney(Player* player, Creature* creature);
-    static void ProcessLootRelease(ObjectGuid lguid, Player* player, Loot* loot);
+    static void StartAoeLoot(Player* player, ObjectGuid excludedGuid);
+    static bool ProcessLootSlot(Player* player, ObjectGuid lguid, uint8 lootSlot, AoeLootSweep* sweep = nullptr);
+    static bool ProcessLootMoney(Player* player, Loot* loot, std::vector<Player*> const& moneyShareMembers);
+    static void ProcessLootRelease(Player* player, std::vector<Creature*> const& releasedCorpses);
+    static void ProcessGameObjectRelease(Player* player, std::vector<GameObject*> const& releasedGameObjects);
+    static void ApplySkillUps(Player* player, std::vector<AoeLootSkillUp> const& skillUps);
 
     // Helper functions
     static void DebugMessage(Player* player, const std::string& message);
     static std::vector<Player*> GetGroupMembers(Player* player);
-    static void ProcessQuestItems(Player* player, ObjectGuid lguid, Loot* loot);
+    static std::vector<Player*> GetMoneyShareMembers(Player* player);
+    static void ProcessQuestItems(Player* player, ObjectGuid lguid, Loot* loot, uint8 minItemQuality, AoeLootPlayerFilter const* playerFilter);
+    static bool StoreLootSlot(Player* player, ObjectGuid lguid, Loot* loot, uint8 lootSlot, AoeLootSweep* sweep = nullptr);
+    static bool QueueOverflowItem(Player* player, ObjectGuid lguid, Loot* loot, uint8 lootSlot, AoeLootSweep& sweep);
+    static void SendOverflowMail(Player* player, std::vector<AoeLootOverflowItem> const& overflowItems);
     static std::pair<Loot*, bool> GetLootObject(Player* player, ObjectGuid lguid);
     static std::vector<Creature*> GetValidCorpses(Player* player, float range);
-    static void ProcessCreatureLoot(Player* player, Creature* creature);
+    static std::vector<Creature*> GetGroupCorpses(Player* player, Group* group, float range);
+    static void ProcessCreatureLoot(Player* player, Creature* creature, AoeLootSweep& sweep);
+    static void ProcessGroupCreatureLoot(Player* player, Creature* creature, AoeLootSweep& sweep);
     static bool IsValidLootTarget(Player* player, Creature* creature);
+    static std::vector<GameObject*> GetValidGameObjects(Player* player, float range);
+    static bool IsValidGameObjectTarget(Player* player, GameObject* go, uint32& skillId, uint32& reqSkillValue);
+    static void ProcessGameObjectLoot(Player* player, GameObject* go, AoeLootSweep& sweep);
+    static std::vector<Item*> GetLootableContainers(Player* player);
+    static bool IsLootableContainer(Player* player, Item* item);
+    static bool ProcessContainerLoot(Player* player, Item* item, AoeLootSweep& sweep);
+    static void ProcessSkinningSweep(Player* player, float range, AoeLootSweep& sweep);
+    static bool ProcessSkinningLoot(Player* player, Creature* creature, std::map<uint32, uint32> const& skillValues, AoeLootSweep& sweep);
+
+    // Item filter functions
+    static void LoadItemFilterTable();
+    static bool IsItemFiltered(uint32 itemId, uint8 minItemQuality, AoeLootPlayerFilter const* playerFilter = nullptr);
 
     // Getters and setters for player AOE loot settings
     static bool GetPlayerAoeLootEnabled(uint64 guid);
@@ -87,10 +194,22 @@ public:
     static void RemovePlayerLootDebug(uint64 guid);
     static bool hasPlayerAoeLootEnabled(uint64 guid);
     static bool hasPlayerAoeLootDebug(uint64 guid);
+    static bool IsPlayerAoeLootActive(Player* player);
+    static uint8 GetPlayerAoeLootQuality(uint64 guid);
+    static void SetPlayerAoeLootQuality(uint64 guid, uint8 quality);
+    static void RemovePlayerLootQuality(uint64 guid);
+    static AoeLootPlayerFilter const* GetPlayerAoeLootFilter(uint64 guid);
+    static void RemovePlayerLootFilter(uint64 guid);
 
 private:
     static std::map<uint64, bool> playerAoeLootEnabled;
     static std::map<uint64, bool> playerAoeLootDebug;
+    static std::map<uint64, uint8> playerAoeLootQuality;
+    static std::map<uint64, AoeLootPlayerFilter> playerAoeLootFilters;
+
+    // >>>>> One byte per item ID: low bits hold the quality, high bits the server-wide allow/deny verdict. <<<<< //
+
+    static std::vector<uint8> itemFilterTable;
 
 };
 